@@ -5,15 +5,227 @@
  * Copyright (c) 2024 Yaokai Liu. All rights reserved.
  **/
 
+#define _GNU_SOURCE
 #include "allocator.h"
 #include <malloc.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
+#ifdef __linux__
+  #include <sys/mman.h>
+#endif
+
+static void *std_aligned_alloc(size_t alignment, size_t size) {
+  if (alignment < sizeof(void *)) { alignment = sizeof(void *); }
+  return aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+}
+
+static bool std_try_expand(void *ptr, size_t size) {
+  return ptr && malloc_usable_size(ptr) >= size;
+}
+
 const Allocator STDAllocator = {
   .malloc = malloc,
   .realloc = realloc,
   .calloc = calloc,
   .free = free,
   .memcpy = memcpy,
-  .memset = memset
+  .memset = memset,
+  .aligned_alloc = std_aligned_alloc,
+  .try_expand = std_try_expand
+};
+
+#ifdef __linux__
+
+  #define HUGE_PAGE_SIZE ((size_t) 2 << 20)
+
+typedef struct {
+  // Start of the `malloc` block or of the mapping.
+  void *base;
+  // Length of the mapping, 0 for `malloc` blocks.
+  size_t mapped;
+} HugePageHeader;
+
+  #define header_of(_ptr) ((HugePageHeader *) (_ptr) - 1)
+  #define huge_round(_size) (((_size) + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1))
+
+// The kernel only promises page alignment, so map one huge page more and trim the
+// mapping to start on a huge page boundary; otherwise `MADV_HUGEPAGE` may find no
+// whole huge page to back.
+static void *huge_reserve(size_t length) {
+  char *base = mmap(
+    nullptr, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+  );
+  if (base == MAP_FAILED) { return nullptr; }
+  char *aligned = (char *) huge_round((uintptr_t) base);
+  if (aligned != base) { munmap(base, (size_t) (aligned - base)); }
+  munmap(aligned + length, (size_t) (base + HUGE_PAGE_SIZE - aligned));
+  return aligned;
+}
+
+static void *huge_map(size_t size) {
+  const size_t length = huge_round(size + sizeof(HugePageHeader));
+  void *base = huge_reserve(length);
+  if (!base) { return nullptr; }
+  madvise(base, length, MADV_HUGEPAGE);
+  HugePageHeader *header = base;
+  *header = (HugePageHeader) {.base = base, .mapped = length};
+  return header + 1;
+}
+
+static void *huge_malloc(size_t size) {
+  if (size >= HUGE_PAGE_SIZE) { return huge_map(size); }
+  HugePageHeader *header = malloc(sizeof(HugePageHeader) + size);
+  if (!header) { return nullptr; }
+  *header = (HugePageHeader) {.base = header, .mapped = 0};
+  return header + 1;
+}
+
+static void *huge_calloc(size_t count, size_t size) {
+  if (size && count > SIZE_MAX / size) { return nullptr; }
+  void *ptr = huge_malloc(count * size);
+  // Fresh mappings are already zero.
+  if (ptr && !header_of(ptr)->mapped) { memset(ptr, 0, count * size); }
+  return ptr;
+}
+
+static void huge_free(void *ptr) {
+  if (!ptr) { return; }
+  const HugePageHeader *header = header_of(ptr);
+  if (header->mapped) {
+    munmap(header->base, header->mapped);
+  } else {
+    free(header->base);
+  }
+}
+
+static size_t huge_usable_size(void *ptr) {
+  const HugePageHeader *header = header_of(ptr);
+  const size_t total = header->mapped ? header->mapped : malloc_usable_size(header->base);
+  return total - (size_t) ((char *) ptr - (char *) header->base);
+}
+
+static bool huge_try_expand(void *ptr, size_t size) {
+  if (!ptr) { return false; }
+  if (huge_usable_size(ptr) >= size) { return true; }
+  HugePageHeader *header = header_of(ptr);
+  if (!header->mapped || header->base != (void *) header) { return false; }
+  const size_t length = huge_round(size + sizeof(HugePageHeader));
+  if (mremap(header->base, header->mapped, length, 0) == MAP_FAILED) { return false; }
+  madvise(header->base, length, MADV_HUGEPAGE);
+  header->mapped = length;
+  return true;
+}
+
+// Does not try to grow a mapping in place: callers try `Allocator_try_expand` first, and
+// repeating its `mremap` here would only fail again.
+static void *huge_realloc(void *ptr, size_t size) {
+  if (!ptr) { return huge_malloc(size); }
+  if (huge_usable_size(ptr) >= size) { return ptr; }
+  HugePageHeader *header = header_of(ptr);
+  // A mapping that cannot grow in place is moved by the kernel, not copied, onto a
+  // fresh huge page aligned reservation.
+  if (header->mapped && header->base == (void *) header) {
+    const size_t length = huge_round(size + sizeof(HugePageHeader));
+    void *target = huge_reserve(length);
+    if (!target) { return nullptr; }
+    void *base =
+      mremap(header->base, header->mapped, length, MREMAP_MAYMOVE | MREMAP_FIXED, target);
+    if (base == MAP_FAILED) {
+      munmap(target, length);
+      return nullptr;
+    }
+    madvise(base, length, MADV_HUGEPAGE);
+    header = base;
+    *header = (HugePageHeader) {.base = base, .mapped = length};
+    return header + 1;
+  }
+  if (!header->mapped && header->base == (void *) header && size < HUGE_PAGE_SIZE) {
+    header = realloc(header, sizeof(HugePageHeader) + size);
+    if (!header) { return nullptr; }
+    header->base = header;
+    return header + 1;
+  }
+  void *dest = huge_malloc(size);
+  if (!dest) { return nullptr; }
+  const size_t used = huge_usable_size(ptr);
+  memcpy(dest, ptr, used < size ? used : size);
+  huge_free(ptr);
+  return dest;
+}
+
+static void *huge_aligned_alloc(size_t alignment, size_t size) {
+  if (alignment <= sizeof(HugePageHeader)) { return huge_malloc(size); }
+  const size_t extra = sizeof(HugePageHeader) + alignment;
+  if (size + extra >= HUGE_PAGE_SIZE) {
+    void *base = huge_map(size + alignment);
+    if (!base) { return nullptr; }
+    const HugePageHeader origin = *header_of(base);
+    void *ptr = (void *) (((uintptr_t) base + alignment - 1) & ~(uintptr_t) (alignment - 1));
+    *header_of(ptr) = origin;
+    return ptr;
+  }
+  void *base = malloc(size + extra);
+  if (!base) { return nullptr; }
+  uintptr_t addr = (uintptr_t) base + sizeof(HugePageHeader);
+  void *ptr = (void *) ((addr + alignment - 1) & ~(uintptr_t) (alignment - 1));
+  *header_of(ptr) = (HugePageHeader) {.base = base, .mapped = 0};
+  return ptr;
+}
+
+const Allocator HugePageAllocator = {
+  .malloc = huge_malloc,
+  .realloc = huge_realloc,
+  .calloc = huge_calloc,
+  .free = huge_free,
+  .memcpy = memcpy,
+  .memset = memset,
+  .aligned_alloc = huge_aligned_alloc,
+  .try_expand = huge_try_expand
+};
+
+#else
+
+const Allocator HugePageAllocator = {
+  .malloc = malloc,
+  .realloc = realloc,
+  .calloc = calloc,
+  .free = free,
+  .memcpy = memcpy,
+  .memset = memset,
+  .aligned_alloc = std_aligned_alloc,
+  .try_expand = std_try_expand
 };
+
+#endif
+
+// Without `aligned_alloc` the block is over-allocated and the original pointer is
+// kept just before the aligned one.
+void *Allocator_aligned_alloc(const Allocator *allocator, size_t alignment, size_t size) {
+  if (!alignment || (alignment & (alignment - 1))) { return nullptr; }
+  if (allocator->aligned_alloc) { return allocator->aligned_alloc(alignment, size); }
+  void *base = allocator->malloc(size + alignment + sizeof(void *));
+  if (!base) { return nullptr; }
+  const uintptr_t addr = (uintptr_t) base + sizeof(void *);
+  void **ptr = (void **) ((addr + alignment - 1) & ~(uintptr_t) (alignment - 1));
+  ptr[-1] = base;
+  return ptr;
+}
+
+void Allocator_aligned_free(const Allocator *allocator, void *ptr) {
+  if (!ptr) { return; }
+  allocator->free(allocator->aligned_alloc ? ptr : ((void **) ptr)[-1]);
+}
+
+void Allocator_sized_free(const Allocator *allocator, void *ptr, size_t size) {
+  if (allocator->sized_free) {
+    allocator->sized_free(ptr, size);
+  } else {
+    allocator->free(ptr);
+  }
+}
+
+bool Allocator_try_expand(const Allocator *allocator, void *ptr, size_t size) {
+  return ptr && allocator->try_expand && allocator->try_expand(ptr, size);
+}
@@ -8,6 +8,7 @@
 #ifndef LIU_ALLOCATOR_H
 #define LIU_ALLOCATOR_H
 
+#include <stdbool.h>
 #include <stddef.h>
 
 typedef struct {
@@ -22,9 +23,27 @@ typedef struct {
   void *(* const memcpy)(void * restrict dest, const void * restrict src, size_t size);
 
   void *(* const memset)(void *dest, int value, size_t size);
+
+  // Optional entries, may be null. Use the `Allocator_*` helpers, which fall back.
+  void *(* const aligned_alloc)(size_t alignment, size_t size);
+
+  // Plumbing for size-class allocators; neither built-in allocator implements it.
+  void (* const sized_free)(void *ptr, size_t size);
+
+  // Grow the block at `ptr` to `size` bytes without moving it, or return false.
+  bool (* const try_expand)(void *ptr, size_t size);
 } Allocator;
 
 extern const Allocator STDAllocator;
+// Blocks of 2 MiB and more are mapped, advised for transparent huge pages and grown with
+// `mremap`. Smaller blocks come from `malloc`. Only its own `free` may release its blocks.
+extern const Allocator HugePageAllocator;
+
+// `alignment` must be a power of two. Release with `Allocator_aligned_free`.
+void *Allocator_aligned_alloc(const Allocator *allocator, size_t alignment, size_t size);
+void Allocator_aligned_free(const Allocator *allocator, void *ptr);
+void Allocator_sized_free(const Allocator *allocator, void *ptr, size_t size);
+bool Allocator_try_expand(const Allocator *allocator, void *ptr, size_t size);
 
 typedef void destruct_t(void *, const Allocator *);
 
@@ -73,9 +73,12 @@ inline uint32_t Array_append(Array *array, const void *elements, const uint32_t
   if (count == 0) { return 0; }
   if (array->used_len + count >= array->alloc_len) {
     uint32_t length = ((array->used_len + count) / ALLOC_LEN + 1) * ALLOC_LEN;
-    void *p = array->allocator->realloc(array->elements, length * array->ele_size);
-    if (!p) { return -1; }
-    array->elements = p;
+    const size_t size = (size_t) length * array->ele_size;
+    if (!Allocator_try_expand(array->allocator, array->elements, size)) {
+      void *p = array->allocator->realloc(array->elements, size);
+      if (!p) { return -1; }
+      array->elements = p;
+    }
     array->alloc_len = length;
   }
   void *dest = (char *) array->elements + array->ele_size * array->used_len;
@@ -145,7 +148,9 @@ inline uint32_t Array_clear(Array *array, void (*fn_free)(void *, const Allocato
 inline uint32_t Array_reset(Array *array, void (*fn_free)(void *, const Allocator *)) {
   Array_clear(array, fn_free);
   const uint32_t len = array->alloc_len;
-  if (array->elements) { array->allocator->free(array->elements); }
+  if (array->elements) {
+    Allocator_sized_free(array->allocator, array->elements, (size_t) len * array->ele_size);
+  }
   array->elements = nullptr;
   array->alloc_len = 0;
   array->used_len = 0;
@@ -21,14 +21,25 @@ typedef struct AVLTree {
   const Allocator *allocator;
   compare_t *fn_cmp;
   AVLNode *root;
+  uint64_t count;
+#ifdef TRIE_COUNTERS
+  uint64_t compares;
+#endif
 } AVLTree;
 
+const size_t sizeof_avl_tree = sizeof(AVLTree);
+const size_t sizeof_avl_node = sizeof(AVLNode);
+
 AVLNode *AVLNode_new(const uint64_t key, AVLTree *tree);
 
 AVLNode *AVLNode_get(AVLNode *root, uint64_t key, const AVLTree *tree);
 AVLNode *AVLNode_add(AVLNode **root, const uint64_t key, AVLTree *tree);
+AVLNode *AVLNode_remove(AVLNode **root, const uint64_t key, AVLTree *tree);
+AVLNode *AVLNode_pop_min(AVLNode **root);
+void AVLNode_rebalance(AVLNode **root);
 void AVLNode_del(AVLNode *root, destruct_t *del_content, AVLTree *tree);
 void AVLNode_inorder_traversal(AVLNode *node, Array *pair_array);
+int32_t AVLNode_compare(uint64_t key, const AVLNode *node, const AVLTree *tree);
 
 inline AVLTree *AVLTree_new(const Allocator *allocator, compare_t *fn_compare) {
   AVLTree *tree = allocator->calloc(1, sizeof(AVLTree));
@@ -41,6 +52,16 @@ inline uint64_t AVLTree_height(const AVLTree *tree) {
   return tree->root ? tree->root->height + 1 : 0;
 }
 
+inline uint64_t AVLTree_count(const AVLTree *tree) {
+  return tree ? tree->count : 0;
+}
+
+#ifdef TRIE_COUNTERS
+inline uint64_t AVLTree_compares(const AVLTree *tree) {
+  return tree ? tree->compares : 0;
+}
+#endif
+
 inline void *AVLTree_get(const AVLTree *tree, uint64_t key) {
   if (!tree) { return nullptr; }
   const AVLNode * const node = AVLNode_get(tree->root, key, tree);
@@ -53,6 +74,35 @@ inline int32_t AVLTree_set(AVLTree *tree, uint64_t key, void *value) {
   return node ? (node->value = value, 0) : -1;
 }
 
+#define AVL_MAX_HEIGHT 128
+
+// A reader racing a writer may see a subtree mid-rotation and miss a key; callers
+// validate the result, and the height bound keeps a stale walk finite.
+inline void *AVLTree_concurrent_get(const AVLTree *tree, uint64_t key) {
+  if (!tree) { return nullptr; }
+  const AVLNode *node = __atomic_load_n(&tree->root, __ATOMIC_ACQUIRE);
+  for (uint32_t depth = 0; node && depth < AVL_MAX_HEIGHT; depth++) {
+    const int32_t cmp = tree->fn_cmp ? tree->fn_cmp((void *) key, (void *) node->key) :
+                                       (key > node->key) - (key < node->key);
+    if (cmp == 0) { return __atomic_load_n(&node->value, __ATOMIC_ACQUIRE); }
+    node = __atomic_load_n(cmp < 0 ? &node->left : &node->right, __ATOMIC_ACQUIRE);
+  }
+  return nullptr;
+}
+
+inline int32_t AVLTree_concurrent_set(AVLTree *tree, uint64_t key, void *value) {
+  if (!tree) { return -1; }
+  AVLNode *node = AVLNode_add(&tree->root, key, tree);
+  if (!node) { return -1; }
+  __atomic_store_n(&node->value, value, __ATOMIC_RELEASE);
+  return 0;
+}
+
+inline void *AVLTree_concurrent_del(AVLTree *tree, uint64_t key) {
+  if (!tree) { return nullptr; }
+  return AVLNode_remove(&tree->root, key, tree);
+}
+
 inline Array /*<AVLPair>*/ *
   AVLTree_inorder_traversal(AVLTree *tree, uint32_t id, const Allocator *allocator) {
   if (!tree) { return nullptr; }
@@ -78,6 +128,7 @@ inline void AVLNode_del(AVLNode *root, destruct_t *del_content, AVLTree *tree) {
 inline AVLNode *AVLNode_new(const uint64_t key, AVLTree *tree) {
   AVLNode *node = tree->allocator->calloc(1, sizeof(AVLNode));
   node->key = key;
+  tree->count++;
   return node;
 }
 
@@ -89,44 +140,56 @@ inline void AVLNode_inorder_traversal(AVLNode *node, Array *pair_array) {
   if (node->right) { AVLNode_inorder_traversal(node->right, pair_array); }
 }
 
+// Without `fn_cmp` keys compare as unsigned integers; a truncated difference
+// would misorder keys that are 2^31 or more apart.
+inline int32_t AVLNode_compare(uint64_t key, const AVLNode *node, const AVLTree *tree) {
+#ifdef TRIE_COUNTERS
+  ((AVLTree *) tree)->compares++;
+#endif
+  if (tree->fn_cmp) { return tree->fn_cmp((void *) key, (void *) node->key); }
+  return (key > node->key) - (key < node->key);
+}
+
 inline AVLNode *AVLNode_get(AVLNode *root, uint64_t key, const AVLTree *tree) {
   if (!root) { return nullptr; }
-  int32_t cmp =
-    tree->fn_cmp ? tree->fn_cmp((void *) key, (void *) root->key) : (int32_t) (key - root->key);
+  int32_t cmp = AVLNode_compare(key, root, tree);
   if (cmp > 0) { return AVLNode_get(root->right, key, tree); }
   if (cmp < 0) { return AVLNode_get(root->left, key, tree); }
   return root;
 }
 
 #define max(_a, _b) ((_a) > (_b) ? (_a) : (_b))
-#define LL_rotate(_pNode)                                                                         \
-  do {                                                                                            \
-    AVLNode *temp = *_pNode;                                                                      \
-    *_pNode = temp->left;                                                                         \
-    temp->left = (*_pNode)->right;                                                                \
-    (*_pNode)->right = temp;                                                                      \
-    uint64_t tlh = temp->left ? temp->left->height + 1 : 0;                                       \
-    uint64_t trh = temp->right ? temp->right->height + 1 : 0;                                     \
-    temp->height = max(tlh, trh);                                                                 \
-    (*_pNode)->height = max((*_pNode)->left ? (*_pNode)->left->height + 1 : 0, temp->height + 1); \
+// Links are published with release stores, and a subtree root only after the subtree
+// below it is rewired, so `AVLTree_concurrent_get` never follows a half-built link.
+#define publish(_link, _node) __atomic_store_n(&(_link), (_node), __ATOMIC_RELEASE)
+#define LL_rotate(_pNode)                                                       \
+  do {                                                                          \
+    AVLNode *temp = *_pNode;                                                    \
+    AVLNode *top = temp->left;                                                  \
+    publish(temp->left, top->right);                                            \
+    publish(top->right, temp);                                                  \
+    uint64_t tlh = temp->left ? temp->left->height + 1 : 0;                     \
+    uint64_t trh = temp->right ? temp->right->height + 1 : 0;                   \
+    temp->height = max(tlh, trh);                                               \
+    top->height = max(top->left ? top->left->height + 1 : 0, temp->height + 1); \
+    publish(*_pNode, top);                                                      \
   } while (0)
 #define RR_rotate(_pNode)                                                             \
   do {                                                                                \
     AVLNode *temp = *_pNode;                                                          \
-    *_pNode = temp->right;                                                            \
-    temp->right = (*_pNode)->left;                                                    \
-    (*_pNode)->left = temp;                                                           \
+    AVLNode *top = temp->right;                                                       \
+    publish(temp->right, top->left);                                                  \
+    publish(top->left, temp);                                                         \
     uint64_t tlh = temp->left ? temp->left->height + 1 : 0;                           \
     uint64_t trh = temp->right ? temp->right->height + 1 : 0;                         \
     temp->height = max(tlh, trh);                                                     \
-    (*_pNode)->height =                                                               \
-      1 + max((*_pNode)->right ? (*_pNode)->right->height + 1 : 0, temp->height + 1); \
+    top->height = 1 + max(top->right ? top->right->height + 1 : 0, temp->height + 1); \
+    publish(*_pNode, top);                                                            \
   } while (0)
 
 #define setNode(node)                                                                \
   do {                                                                               \
-    int32_t cmp = tree->fn_cmp ? tree->fn_cmp((void *) key, (void *) (*root)->key) : \
-                                 (int32_t) (key - (*root)->key);                     \
+    int32_t cmp = AVLNode_compare(key, *root, tree);                                 \
     if (cmp == 0) { return *root; }                                                  \
     AVLNode **pNode = (cmp < 0) ? &((*root)->left) : &((*root)->right);              \
     node = AVLNode_add(pNode, key, tree);                                            \
@@ -134,12 +197,17 @@ inline AVLNode *AVLNode_get(AVLNode *root, uint64_t key, const AVLTree *tree) {
 
 inline AVLNode *AVLNode_add(AVLNode **root, const uint64_t key, AVLTree *tree) {
   if (!*root) {
-    *root = AVLNode_new(key, tree);
-    return *root;
+    AVLNode *node = AVLNode_new(key, tree);
+    publish(*root, node);
+    return node;
   }
   AVLNode *node;
   setNode(node);
+  AVLNode_rebalance(root);
+  return node;
+}
 
+inline void AVLNode_rebalance(AVLNode **root) {
   uint64_t left_height = (*root)->left ? (*root)->left->height + 1 : 0;
   uint64_t right_height = (*root)->right ? (*root)->right->height + 1 : 0;
   if (left_height >= 2 + right_height) {
@@ -156,6 +224,41 @@ inline AVLNode *AVLNode_add(AVLNode **root, const uint64_t key, AVLTree *tree) {
   left_height = (*root)->left ? (*root)->left->height + 1 : 0;
   right_height = (*root)->right ? (*root)->right->height + 1 : 0;
   (*root)->height = max(left_height, right_height);
+}
+
+// Unlinks the leftmost node under `*root` and returns it.
+inline AVLNode *AVLNode_pop_min(AVLNode **root) {
+  AVLNode *node = *root;
+  if (!node->left) {
+    publish(*root, node->right);
+    return node;
+  }
+  AVLNode *min = AVLNode_pop_min(&node->left);
+  AVLNode_rebalance(root);
+  return min;
+}
 
+// The removed node is replaced by its successor rather than overwritten, so a reader
+// standing on it never sees its key change.
+inline AVLNode *AVLNode_remove(AVLNode **root, const uint64_t key, AVLTree *tree) {
+  AVLNode *node = *root;
+  if (!node) { return nullptr; }
+  const int32_t cmp = AVLNode_compare(key, node, tree);
+  if (cmp != 0) {
+    AVLNode *removed = AVLNode_remove(cmp < 0 ? &node->left : &node->right, key, tree);
+    if (removed) { AVLNode_rebalance(root); }
+    return removed;
+  }
+  if (!node->left || !node->right) {
+    publish(*root, node->left ? node->left : node->right);
+  } else {
+    AVLNode *right = node->right;
+    AVLNode *successor = AVLNode_pop_min(&right);
+    publish(successor->left, node->left);
+    publish(successor->right, right);
+    publish(*root, successor);
+    AVLNode_rebalance(root);
+  }
+  tree->count--;
   return node;
 }
@@ -15,11 +15,28 @@ typedef struct AVLTree AVLTree;
 
 typedef int32_t compare_t(void *, void *);
 
+extern const size_t sizeof_avl_tree;
+extern const size_t sizeof_avl_node;
+
 AVLTree *AVLTree_new(const Allocator *allocator, compare_t(*fn_compare));
 void AVLTree_destroy(AVLTree *tree, destruct_t *del_value);
 
 uint64_t AVLTree_height(const AVLTree *tree);
+uint64_t AVLTree_count(const AVLTree *tree);
 void *AVLTree_get(const AVLTree *tree, uint64_t key);
 int32_t AVLTree_set(AVLTree *tree, uint64_t key, void *value);
 
+// For trees shared by lock-free readers and one writer at a time, serialized by the
+// caller. Readers use `AVLTree_concurrent_get` only; the writer uses the set.
+void *AVLTree_concurrent_get(const AVLTree *tree, uint64_t key);
+int32_t AVLTree_concurrent_set(AVLTree *tree, uint64_t key, void *value);
+// Unlinks `key` and returns its node, or null. Readers may still stand on the node, so
+// the caller frees it with the tree's allocator once none can reach it.
+void *AVLTree_concurrent_del(AVLTree *tree, uint64_t key);
+
+#ifdef TRIE_COUNTERS
+// Key comparisons made by this tree since it was created.
+uint64_t AVLTree_compares(const AVLTree *tree);
+#endif
+
 #endif  // LIU_AVL_TREE_H
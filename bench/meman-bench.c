@@ -0,0 +1,727 @@
+/**
+ * Project Name: machine
+ * Module Name: meman
+ * Filename: meman-bench.c
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-18
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ *
+ * Microbenchmarks for meman containers, run against every allocator.
+ * Build from the repository root:
+ *   cmake -S . -B build -DCMAKE_BUILD_TYPE=Release && cmake --build build --target meman-bench
+ * Usage: meman-bench [-n size[,size...]] [-s seed] [-f filter] [-t threads] > bench_output.txt
+ * `filter` is matched against "Container.op". Results are written to stdout as JSON.
+ * Concurrent workloads sweep 1, 2, 4, ... reader threads up to `threads`, which defaults
+ * to the number of online CPUs.
+ **/
+
+#define _GNU_SOURCE
+#include "allocator.h"
+#include "array.h"
+#include "avl-tree.h"
+#include "concurrent-trie.h"
+#include "hash-map.h"
+#include "stack.h"
+#include "trie-dump.h"
+#include "trie.h"
+#include <math.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_SIZES 16
+// Leaves an epoch slot free for the writer of mixed workloads.
+#define MAX_THREADS 64
+
+// ---- Allocation counting ----
+
+typedef struct {
+  uint64_t malloc;
+  uint64_t calloc;
+  uint64_t realloc;
+  uint64_t aligned_alloc;
+  uint64_t free;
+  uint64_t bytes;
+} AllocCounters;
+
+// Allocator entries carry no context, so every counted allocator gets its own
+// wrappers and counters.
+#define COUNTING_ALLOCATOR(_name, _base)                                             \
+  static AllocCounters _name##_counters;                                             \
+  static void *_name##_malloc(size_t size) {                                         \
+    _name##_counters.malloc++;                                                       \
+    _name##_counters.bytes += size;                                                  \
+    return (_base).malloc(size);                                                     \
+  }                                                                                  \
+  static void *_name##_realloc(void *ptr, size_t size) {                             \
+    _name##_counters.realloc++;                                                      \
+    _name##_counters.bytes += size;                                                  \
+    return (_base).realloc(ptr, size);                                               \
+  }                                                                                  \
+  static void *_name##_calloc(size_t count, size_t size) {                           \
+    _name##_counters.calloc++;                                                       \
+    _name##_counters.bytes += count * size;                                          \
+    return (_base).calloc(count, size);                                              \
+  }                                                                                  \
+  static void _name##_free(void *ptr) {                                              \
+    if (ptr) { _name##_counters.free++; }                                            \
+    (_base).free(ptr);                                                               \
+  }                                                                                  \
+  static void *_name##_aligned_alloc(size_t alignment, size_t size) {                \
+    _name##_counters.aligned_alloc++;                                                \
+    _name##_counters.bytes += size;                                                  \
+    return Allocator_aligned_alloc(&(_base), alignment, size);                       \
+  }                                                                                  \
+  static void _name##_sized_free(void *ptr, size_t size) {                           \
+    if (ptr) { _name##_counters.free++; }                                            \
+    Allocator_sized_free(&(_base), ptr, size);                                       \
+  }                                                                                  \
+  static bool _name##_try_expand(void *ptr, size_t size) {                           \
+    return Allocator_try_expand(&(_base), ptr, size);                                \
+  }                                                                                  \
+  static const Allocator _name = {                                                   \
+    .malloc = _name##_malloc,                                                        \
+    .realloc = _name##_realloc,                                                      \
+    .calloc = _name##_calloc,                                                        \
+    .free = _name##_free,                                                            \
+    .memcpy = memcpy,                                                                \
+    .memset = memset,                                                                \
+    .aligned_alloc = _name##_aligned_alloc,                                          \
+    .sized_free = _name##_sized_free,                                                \
+    .try_expand = _name##_try_expand                                                 \
+  };
+
+COUNTING_ALLOCATOR(CountedSTD, STDAllocator)
+COUNTING_ALLOCATOR(CountedHugePage, HugePageAllocator)
+
+typedef struct {
+  const char *name;
+  const Allocator *allocator;
+  AllocCounters *counters;
+} BenchAllocator;
+
+static const BenchAllocator allocators[] = {
+  {"STDAllocator",      &CountedSTD,      &CountedSTD_counters     },
+  {"HugePageAllocator", &CountedHugePage, &CountedHugePage_counters},
+};
+
+// ---- Keys ----
+
+typedef enum {
+  DIST_SEQUENTIAL,
+  DIST_RANDOM,
+  DIST_ZIPFIAN,
+  DIST_STRING,
+  DIST_COUNT
+} Distribution;
+
+static const char * const dist_names[] = {"sequential", "random", "zipfian", "string"};
+
+typedef struct {
+  Distribution dist;
+  uint64_t size;
+  // `size` distinct keys. Integer keys for AVLTree and HashMap, or `char *` for DIST_STRING.
+  uint64_t *universe;
+  // The same keys as NUL-terminated strings for Trie.
+  char **strings;
+  // `size` accesses, as indexes into `universe`.
+  uint64_t *order;
+} KeySet;
+
+static uint64_t splitmix64(uint64_t *state) {
+  uint64_t z = (*state += 0x9E37'79B9'7F4A'7C15);
+  z = (z ^ (z >> 30)) * 0xBF58'476D'1CE4'E5B9;
+  z = (z ^ (z >> 27)) * 0x94D0'49BB'1331'11EB;
+  return z ^ (z >> 31);
+}
+
+static double uniform01(uint64_t *state) {
+  return (double) (splitmix64(state) >> 11) * 0x1.0p-53;
+}
+
+// Zipfian ranks in [0, n) with skew `theta`, as in YCSB.
+typedef struct {
+  uint64_t n;
+  double theta;
+  double alpha;
+  double zetan;
+  double eta;
+} Zipf;
+
+static void zipf_init(Zipf *zipf, uint64_t n, double theta) {
+  double zetan = 0;
+  for (uint64_t i = 1; i <= n; i++) { zetan += 1.0 / pow((double) i, theta); }
+  const double zeta2 = 1.0 + pow(0.5, theta);
+  zipf->n = n;
+  zipf->theta = theta;
+  zipf->alpha = 1.0 / (1.0 - theta);
+  zipf->zetan = zetan;
+  zipf->eta = (1.0 - pow(2.0 / (double) n, 1.0 - theta)) / (1.0 - zeta2 / zetan);
+}
+
+static uint64_t zipf_next(const Zipf *zipf, uint64_t *state) {
+  const double u = uniform01(state);
+  const double uz = u * zipf->zetan;
+  if (uz < 1.0) { return 0; }
+  if (uz < 1.0 + pow(0.5, zipf->theta)) { return 1; }
+  const uint64_t rank =
+    (uint64_t) ((double) zipf->n * pow(zipf->eta * u - zipf->eta + 1.0, zipf->alpha));
+  return rank < zipf->n ? rank : zipf->n - 1;
+}
+
+// Keys shaped like service routes: shared prefixes, varying depth and length.
+static char *make_route(uint64_t index, uint64_t *state) {
+  static const char * const hosts[] = {"api", "auth", "cdn", "search", "billing", "media"};
+  static const char * const resources[] = {"users", "orders", "items", "sessions", "files"};
+  static const char * const actions[] = {"", "/profile", "/history", "/settings", "/v2/export"};
+  char buffer[128];
+  const uint64_t r = splitmix64(state);
+  snprintf(
+    buffer, sizeof(buffer), "%s.example.com/%s/%08llx%s", hosts[r % 6], resources[(r >> 8) % 5],
+    (unsigned long long) index, actions[(r >> 16) % 5]
+  );
+  return strdup(buffer);
+}
+
+static void KeySet_init(KeySet *keys, Distribution dist, uint64_t size, uint64_t seed) {
+  uint64_t state = seed;
+  keys->dist = dist;
+  keys->size = size;
+  keys->universe = malloc(size * sizeof(uint64_t));
+  keys->strings = malloc(size * sizeof(char *));
+  keys->order = malloc(size * sizeof(uint64_t));
+  for (uint64_t i = 0; i < size; i++) {
+    if (dist == DIST_STRING) {
+      keys->strings[i] = make_route(i, &state);
+      keys->universe[i] = (uint64_t) keys->strings[i];
+      continue;
+    }
+    char buffer[24];
+    keys->universe[i] = dist == DIST_SEQUENTIAL ? i + 1 : splitmix64(&state) | 1;
+    snprintf(buffer, sizeof(buffer), "%016llx", (unsigned long long) keys->universe[i]);
+    keys->strings[i] = strdup(buffer);
+  }
+  Zipf zipf;
+  if (dist == DIST_ZIPFIAN) { zipf_init(&zipf, size, 0.99); }
+  for (uint64_t i = 0; i < size; i++) {
+    switch (dist) {
+      case DIST_SEQUENTIAL: keys->order[i] = i; break;
+      case DIST_ZIPFIAN: keys->order[i] = zipf_next(&zipf, &state); break;
+      default: keys->order[i] = splitmix64(&state) % size; break;
+    }
+  }
+}
+
+static void KeySet_release(KeySet *keys) {
+  for (uint64_t i = 0; i < keys->size; i++) { free(keys->strings[i]); }
+  free(keys->universe);
+  free(keys->strings);
+  free(keys->order);
+}
+
+static uint64_t char_key(const void *key) {
+  return *(const uint8_t *) key;
+}
+
+static int32_t string_compare(void *a, void *b) {
+  return strcmp(a, b);
+}
+
+static uint64_t string_hash(void *key) {
+  uint64_t hash = 0xCBF2'9CE4'8422'2325;
+  for (const uint8_t *p = key; *p; p++) { hash = (hash ^ *p) * 0x100'0000'01B3; }
+  return hash;
+}
+
+static bool string_equal(void *a, void *b) {
+  return !strcmp(a, b);
+}
+
+// ---- Measurement ----
+
+typedef struct {
+  const BenchAllocator *allocator;
+  const KeySet *keys;
+  bool sample_latency;
+  // Reader threads of a concurrent workload; 1 for the others.
+  uint32_t threads;
+  uint64_t *latencies;
+  uint64_t ops;
+  uint64_t elapsed_ns;
+  uint64_t begin_ns;
+  AllocCounters allocs;
+  uint64_t peak_rss_kb;
+} Bench;
+
+static inline uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1'000'000'000 + (uint64_t) ts.tv_nsec;
+}
+
+// Lower the kernel's peak RSS mark to the current RSS; needs Linux >= 4.0.
+static void reset_peak_rss(void) {
+  FILE *file = fopen("/proc/self/clear_refs", "w");
+  if (!file) { return; }
+  fputs("5", file);
+  fclose(file);
+}
+
+static uint64_t read_peak_rss_kb(void) {
+  FILE *file = fopen("/proc/self/status", "r");
+  if (!file) { return 0; }
+  char line[256];
+  unsigned long long kb = 0;
+  while (fgets(line, sizeof(line), file)) {
+    if (sscanf(line, "VmHWM: %llu kB", &kb) == 1) { break; }
+  }
+  fclose(file);
+  return kb;
+}
+
+// Setup done before this call is not measured. The latency pass leaves throughput,
+// allocation counts and peak RSS from the untimed pass alone.
+static void bench_begin(Bench *bench) {
+  bench->ops = 0;
+  if (bench->sample_latency) { return; }
+  *bench->allocator->counters = (AllocCounters) {};
+  reset_peak_rss();
+  bench->begin_ns = now_ns();
+}
+
+static void bench_end(Bench *bench) {
+  if (bench->sample_latency) { return; }
+  bench->elapsed_ns = now_ns() - bench->begin_ns;
+  bench->allocs = *bench->allocator->counters;
+  bench->peak_rss_kb = read_peak_rss_kb();
+}
+
+// Each workload runs twice: once untimed for throughput, once timing every op for
+// latency percentiles, so the clock reads do not count toward throughput.
+#define timed(_bench, _stmt)                                           \
+  do {                                                                 \
+    if (!(_bench)->sample_latency) {                                   \
+      _stmt;                                                           \
+      (_bench)->ops++;                                                 \
+      break;                                                           \
+    }                                                                  \
+    const uint64_t _t0 = now_ns();                                     \
+    _stmt;                                                             \
+    (_bench)->latencies[(_bench)->ops++] = now_ns() - _t0;             \
+  } while (false)
+
+// ---- Workloads ----
+
+static void bench_array_append(Bench *bench) {
+  Array *array = Array_new(sizeof(uint64_t), 1, bench->allocator->allocator);
+  bench_begin(bench);
+  for (uint64_t i = 0; i < bench->keys->size; i++) {
+    timed(bench, Array_append(array, &bench->keys->universe[i], 1));
+  }
+  bench_end(bench);
+  releasePrimeArray(array);
+}
+
+static void release_stack(Stack *stack, const Allocator *allocator) {
+  Stack_clear(stack);
+  allocator->free(stack);
+}
+
+static void bench_stack_push(Bench *bench) {
+  Stack *stack = Stack_new(bench->allocator->allocator);
+  bench_begin(bench);
+  for (uint64_t i = 0; i < bench->keys->size; i++) {
+    timed(bench, Stack_push(stack, &bench->keys->universe[i], sizeof(uint64_t)));
+  }
+  bench_end(bench);
+  release_stack(stack, bench->allocator->allocator);
+}
+
+static void bench_stack_pop(Bench *bench) {
+  Stack *stack = Stack_new(bench->allocator->allocator);
+  for (uint64_t i = 0; i < bench->keys->size; i++) {
+    Stack_push(stack, &bench->keys->universe[i], sizeof(uint64_t));
+  }
+  uint64_t value;
+  bench_begin(bench);
+  for (uint64_t i = 0; i < bench->keys->size; i++) {
+    timed(bench, Stack_pop(stack, &value, sizeof(uint64_t)));
+  }
+  bench_end(bench);
+  release_stack(stack, bench->allocator->allocator);
+}
+
+static AVLTree *new_avl_tree(const Bench *bench) {
+  const bool strings = bench->keys->dist == DIST_STRING;
+  return AVLTree_new(bench->allocator->allocator, strings ? string_compare : nullptr);
+}
+
+static void bench_avl_set(Bench *bench) {
+  const KeySet *keys = bench->keys;
+  AVLTree *tree = new_avl_tree(bench);
+  bench_begin(bench);
+  for (uint64_t i = 0; i < keys->size; i++) {
+    timed(bench, AVLTree_set(tree, keys->universe[keys->order[i]], (void *) (i + 1)));
+  }
+  bench_end(bench);
+  AVLTree_destroy(tree, nullptr);
+}
+
+static void bench_avl_get(Bench *bench) {
+  const KeySet *keys = bench->keys;
+  AVLTree *tree = new_avl_tree(bench);
+  for (uint64_t i = 0; i < keys->size; i++) {
+    AVLTree_set(tree, keys->universe[i], (void *) (i + 1));
+  }
+  void * volatile sink;
+  bench_begin(bench);
+  for (uint64_t i = 0; i < keys->size; i++) {
+    timed(bench, sink = AVLTree_get(tree, keys->universe[keys->order[i]]));
+  }
+  bench_end(bench);
+  (void) sink;
+  AVLTree_destroy(tree, nullptr);
+}
+
+static Trie *new_filled_trie(const Bench *bench) {
+  const KeySet *keys = bench->keys;
+  Trie *trie = Trie_new(1, char_key, bench->allocator->allocator);
+  for (uint64_t i = 0; i < keys->size; i++) { Trie_set(trie, keys->strings[i], (void *) (i + 1)); }
+  return trie;
+}
+
+static void bench_trie_set(Bench *bench) {
+  const KeySet *keys = bench->keys;
+  Trie *trie = Trie_new(1, char_key, bench->allocator->allocator);
+  bench_begin(bench);
+  for (uint64_t i = 0; i < keys->size; i++) {
+    timed(bench, Trie_set(trie, keys->strings[keys->order[i]], (void *) (i + 1)));
+  }
+  bench_end(bench);
+  Trie_destroy(trie);
+}
+
+static void bench_trie_get(Bench *bench) {
+  const KeySet *keys = bench->keys;
+  Trie *trie = new_filled_trie(bench);
+  void * volatile sink;
+  bench_begin(bench);
+  for (uint64_t i = 0; i < keys->size; i++) {
+    timed(bench, sink = Trie_get(trie, keys->strings[keys->order[i]]));
+  }
+  bench_end(bench);
+  (void) sink;
+  Trie_destroy(trie);
+}
+
+static void bench_trie_del(Bench *bench) {
+  const KeySet *keys = bench->keys;
+  Trie *trie = new_filled_trie(bench);
+  bench_begin(bench);
+  for (uint64_t i = 0; i < keys->size; i++) {
+    timed(bench, Trie_del(trie, keys->strings[keys->order[i]], nullptr));
+  }
+  bench_end(bench);
+  Trie_destroy(trie);
+}
+
+static void bench_trie_dump(Bench *bench) {
+  const Allocator *allocator = bench->allocator->allocator;
+  Trie *trie = new_filled_trie(bench);
+  Array *key_array = Array_new(sizeof(TrieKeyItem), 1, allocator);
+  Array *node_array = Array_new(sizeof(TrieNodeItem), 2, allocator);
+  bench_begin(bench);
+  timed(bench, Trie_dump(trie, key_array, node_array));
+  bench_end(bench);
+  releasePrimeArray(key_array);
+  releasePrimeArray(node_array);
+  Trie_destroy(trie);
+}
+
+static HashMap *new_hash_map(const Bench *bench) {
+  const bool strings = bench->keys->dist == DIST_STRING;
+  return HashMap_new(
+    bench->allocator->allocator, strings ? string_hash : nullptr, strings ? string_equal : nullptr
+  );
+}
+
+static void bench_hash_map_set(Bench *bench) {
+  const KeySet *keys = bench->keys;
+  HashMap *map = new_hash_map(bench);
+  bench_begin(bench);
+  for (uint64_t i = 0; i < keys->size; i++) {
+    timed(bench, HashMap_set(map, keys->universe[keys->order[i]], (void *) (i + 1)));
+  }
+  bench_end(bench);
+  HashMap_destroy(map, nullptr);
+}
+
+static void bench_hash_map_get(Bench *bench) {
+  const KeySet *keys = bench->keys;
+  HashMap *map = new_hash_map(bench);
+  for (uint64_t i = 0; i < keys->size; i++) {
+    HashMap_set(map, keys->universe[i], (void *) (i + 1));
+  }
+  void * volatile sink;
+  bench_begin(bench);
+  for (uint64_t i = 0; i < keys->size; i++) {
+    timed(bench, sink = HashMap_get(map, keys->universe[keys->order[i]]));
+  }
+  bench_end(bench);
+  (void) sink;
+  HashMap_destroy(map, nullptr);
+}
+
+// ---- Concurrent workloads ----
+
+typedef struct {
+  // This thread's copy; `latencies` points at its share of the samples.
+  Bench bench;
+  ConcurrentTrie *trie;
+  uint64_t first;
+  uint64_t count;
+  atomic_bool *start;
+  atomic_bool *stop;
+} ConcurrentWorker;
+
+static void *guarded_get(ConcurrentTrie *trie, const char *key) {
+  ConcurrentTrieGuard *guard = ConcurrentTrie_enter(trie);
+  void *value = ConcurrentTrie_get(trie, key);
+  ConcurrentTrie_leave(guard);
+  return value;
+}
+
+static void wait_start(const ConcurrentWorker *worker) {
+  while (!atomic_load_explicit(worker->start, memory_order_acquire)) { thrd_yield(); }
+}
+
+static int concurrent_reader(void *arg) {
+  ConcurrentWorker *worker = arg;
+  const KeySet *keys = worker->bench.keys;
+  void * volatile sink;
+  wait_start(worker);
+  for (uint64_t i = worker->first; i < worker->first + worker->count; i++) {
+    timed(&worker->bench, sink = guarded_get(worker->trie, keys->strings[keys->order[i]]));
+  }
+  (void) sink;
+  return 0;
+}
+
+// Deletes and re-inserts keys in turn until the readers are done.
+static int concurrent_writer(void *arg) {
+  ConcurrentWorker *worker = arg;
+  const KeySet *keys = worker->bench.keys;
+  wait_start(worker);
+  for (uint64_t i = 0; !atomic_load_explicit(worker->stop, memory_order_relaxed); i++) {
+    const char *key = keys->strings[i % keys->size];
+    ConcurrentTrie_del(worker->trie, key, nullptr);
+    ConcurrentTrie_set(worker->trie, key, (void *) (i + 1), nullptr);
+  }
+  return 0;
+}
+
+// The keys are split evenly over `bench->threads` readers; only reader ops are counted,
+// so throughput is the readers' aggregate.
+static void run_concurrent_trie(Bench *bench, bool with_writer) {
+  const KeySet *keys = bench->keys;
+  ConcurrentTrie *trie = ConcurrentTrie_new(1, char_key, bench->allocator->allocator);
+  for (uint64_t i = 0; i < keys->size; i++) {
+    ConcurrentTrie_set(trie, keys->strings[i], (void *) (i + 1), nullptr);
+  }
+  const uint64_t share = keys->size / bench->threads;
+  atomic_bool start = false, stop = false;
+  ConcurrentWorker workers[MAX_THREADS + 1];
+  thrd_t threads[MAX_THREADS + 1];
+  const uint32_t count = bench->threads + with_writer;
+  for (uint32_t t = 0; t < count; t++) {
+    const bool writer = t == bench->threads;
+    workers[t] = (ConcurrentWorker) {
+      .bench = *bench,
+      .trie = trie,
+      .first = writer ? 0 : t * share,
+      .count = writer ? 0 : share,
+      .start = &start,
+      .stop = &stop,
+    };
+    workers[t].bench.latencies = bench->latencies + workers[t].first;
+    workers[t].bench.ops = 0;
+    thrd_create(&threads[t], writer ? concurrent_writer : concurrent_reader, &workers[t]);
+  }
+  bench_begin(bench);
+  atomic_store_explicit(&start, true, memory_order_release);
+  for (uint32_t t = 0; t < bench->threads; t++) { thrd_join(threads[t], nullptr); }
+  atomic_store_explicit(&stop, true, memory_order_relaxed);
+  if (with_writer) { thrd_join(threads[bench->threads], nullptr); }
+  bench_end(bench);
+  for (uint32_t t = 0; t < bench->threads; t++) { bench->ops += workers[t].bench.ops; }
+  ConcurrentTrie_destroy(trie);
+}
+
+static void bench_concurrent_trie_get(Bench *bench) {
+  run_concurrent_trie(bench, false);
+}
+
+static void bench_concurrent_trie_mixed(Bench *bench) {
+  run_concurrent_trie(bench, true);
+}
+
+typedef struct {
+  const char *container;
+  const char *op;
+  void (*fn_run)(Bench *);
+  // Run once per size instead of once per key distribution.
+  bool keyless;
+  // Run once per reader thread count of the sweep.
+  bool threaded;
+} Workload;
+
+static const Workload workloads[] = {
+  {"Array",          "append", bench_array_append,          true,  false},
+  {"Stack",          "push",   bench_stack_push,            true,  false},
+  {"Stack",          "pop",    bench_stack_pop,             true,  false},
+  {"AVLTree",        "set",    bench_avl_set,               false, false},
+  {"AVLTree",        "get",    bench_avl_get,               false, false},
+  {"Trie",           "set",    bench_trie_set,              false, false},
+  {"Trie",           "get",    bench_trie_get,              false, false},
+  {"Trie",           "del",    bench_trie_del,              false, false},
+  {"Trie",           "dump",   bench_trie_dump,             false, false},
+  {"HashMap",        "set",    bench_hash_map_set,          false, false},
+  {"HashMap",        "get",    bench_hash_map_get,          false, false},
+  {"ConcurrentTrie", "get",    bench_concurrent_trie_get,   false, true },
+  {"ConcurrentTrie", "mixed",  bench_concurrent_trie_mixed, false, true },
+};
+
+// ---- Report ----
+
+static int compare_u64(const void *a, const void *b) {
+  const uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+  return (x > y) - (x < y);
+}
+
+static uint64_t percentile(const uint64_t *sorted, uint64_t count, double p) {
+  if (!count) { return 0; }
+  const uint64_t index = (uint64_t) (p * (double) (count - 1) + 0.5);
+  return sorted[index];
+}
+
+static void print_result(
+  const Bench *bench, const Workload *workload, const char *distribution, bool *first
+) {
+  qsort(bench->latencies, bench->ops, sizeof(uint64_t), compare_u64);
+  const double seconds = (double) bench->elapsed_ns / 1e9;
+  const AllocCounters *allocs = &bench->allocs;
+  printf(
+    "%s\n    {\"container\": \"%s\", \"op\": \"%s\", \"allocator\": \"%s\", "
+    "\"distribution\": \"%s\", \"threads\": %u, \"size\": %llu, \"ops\": %llu, "
+    "\"seconds\": %.9f, \"ops_per_sec\": %.1f,\n     \"latency_ns\": {\"p50\": %llu, \"p90\": %llu, "
+    "\"p99\": %llu, \"p999\": %llu, \"max\": %llu},\n     \"peak_rss_kb\": %llu, "
+    "\"allocations\": {\"malloc\": %llu, \"calloc\": %llu, \"realloc\": %llu, "
+    "\"aligned_alloc\": %llu, \"free\": %llu, \"bytes\": %llu}}",
+    *first ? "" : ",", workload->container, workload->op, bench->allocator->name, distribution,
+    bench->threads, (unsigned long long) bench->keys->size, (unsigned long long) bench->ops,
+    seconds, seconds > 0 ? (double) bench->ops / seconds : 0.0,
+    (unsigned long long) percentile(bench->latencies, bench->ops, 0.50),
+    (unsigned long long) percentile(bench->latencies, bench->ops, 0.90),
+    (unsigned long long) percentile(bench->latencies, bench->ops, 0.99),
+    (unsigned long long) percentile(bench->latencies, bench->ops, 0.999),
+    (unsigned long long) (bench->ops ? bench->latencies[bench->ops - 1] : 0),
+    (unsigned long long) bench->peak_rss_kb, (unsigned long long) allocs->malloc,
+    (unsigned long long) allocs->calloc, (unsigned long long) allocs->realloc,
+    (unsigned long long) allocs->aligned_alloc, (unsigned long long) allocs->free,
+    (unsigned long long) allocs->bytes
+  );
+  *first = false;
+}
+
+static uint64_t timer_overhead_ns(void) {
+  enum { ROUNDS = 100'000 };
+  const uint64_t begin = now_ns();
+  for (uint32_t i = 0; i < ROUNDS; i++) { (void) now_ns(); }
+  return (now_ns() - begin) / ROUNDS;
+}
+
+static uint32_t min_u32(uint32_t a, uint32_t b) {
+  return a < b ? a : b;
+}
+
+static bool workload_selected(const Workload *workload, const char *filter) {
+  if (!filter) { return true; }
+  char name[64];
+  snprintf(name, sizeof(name), "%s.%s", workload->container, workload->op);
+  return strstr(name, filter) != nullptr;
+}
+
+int main(int argc, char *argv[]) {
+  uint64_t sizes[MAX_SIZES] = {1'000, 100'000};
+  uint32_t size_count = 2;
+  uint64_t seed = 42;
+  const char *filter = nullptr;
+  const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  uint32_t max_threads = cpus < 1 ? 1 : cpus > MAX_THREADS ? MAX_THREADS : (uint32_t) cpus;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (!strcmp(argv[i], "-n")) {
+      size_count = 0;
+      for (char *p = argv[i + 1], *end; *p && size_count < MAX_SIZES; p = end + (*end == ',')) {
+        sizes[size_count++] = strtoull(p, &end, 10);
+        if (end == p) { break; }
+      }
+    } else if (!strcmp(argv[i], "-s")) {
+      seed = strtoull(argv[i + 1], nullptr, 10);
+    } else if (!strcmp(argv[i], "-f")) {
+      filter = argv[i + 1];
+    } else if (!strcmp(argv[i], "-t")) {
+      const unsigned long threads = strtoul(argv[i + 1], nullptr, 10);
+      max_threads = !threads ? 1 : threads > MAX_THREADS ? MAX_THREADS : (uint32_t) threads;
+    } else {
+      fprintf(
+        stderr, "usage: %s [-n size[,size...]] [-s seed] [-f filter] [-t threads]\n", argv[0]
+      );
+      return 1;
+    }
+  }
+
+  printf(
+    "{\n  \"seed\": %llu,\n  \"timer_overhead_ns\": %llu,\n  \"results\": [",
+    (unsigned long long) seed, (unsigned long long) timer_overhead_ns()
+  );
+  bool first = true;
+  for (uint32_t s = 0; s < size_count; s++) {
+    if (!sizes[s]) { continue; }
+    uint64_t *latencies = malloc(sizes[s] * sizeof(uint64_t));
+    // Touch the samples now so they do not count toward any workload's peak RSS.
+    memset(latencies, 0, sizes[s] * sizeof(uint64_t));
+    for (Distribution dist = 0; dist < DIST_COUNT; dist++) {
+      KeySet keys;
+      KeySet_init(&keys, dist, sizes[s], seed);
+      for (uint32_t w = 0; w < sizeof(workloads) / sizeof(Workload); w++) {
+        const Workload *workload = &workloads[w];
+        if (workload->keyless && dist != DIST_SEQUENTIAL) { continue; }
+        if (!workload_selected(workload, filter)) { continue; }
+        for (uint32_t a = 0; a < sizeof(allocators) / sizeof(BenchAllocator); a++) {
+          for (uint32_t threads = 1;; threads = min_u32(threads * 2, max_threads)) {
+            Bench bench = {
+              .allocator = &allocators[a],
+              .keys = &keys,
+              .threads = threads,
+              .latencies = latencies,
+            };
+            workload->fn_run(&bench);
+            bench.sample_latency = true;
+            workload->fn_run(&bench);
+            print_result(&bench, workload, workload->keyless ? "none" : dist_names[dist], &first);
+            fflush(stdout);
+            if (!workload->threaded || threads == max_threads) { break; }
+          }
+        }
+      }
+      KeySet_release(&keys);
+    }
+    free(latencies);
+  }
+  printf("\n  ]\n}\n");
+  return 0;
+}
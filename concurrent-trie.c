@@ -0,0 +1,348 @@
+/**
+ * Filename: concurrent-trie.c
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-18
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#include "concurrent-trie.h"
+#include "array.h"
+#include "avl-tree.h"
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <threads.h>
+
+typedef struct ConcurrentTrieNode ConcurrentTrieNode;
+
+typedef struct ConcurrentTrieNode {
+  // Odd while a writer holds the node; readers retry if it changed under them.
+  _Atomic uint64_t version;
+  void *_Atomic value;
+  AVLTree *children;
+  bool retired;
+} ConcurrentTrieNode;
+
+#define CACHE_LINE_SIZE 64
+
+// Each slot takes a whole cache line; the trie is allocated cache-line aligned.
+typedef struct ConcurrentTrieGuard {
+  // 0 when free, `(epoch << 1) | 1` while a thread is inside an operation.
+  alignas(CACHE_LINE_SIZE) _Atomic uint64_t state;
+} EpochSlot;
+
+typedef struct {
+  void *ptr;
+  destruct_t *fn_del;
+} RetiredItem;
+
+typedef struct {
+  ConcurrentTrieNode *node;
+  uint64_t v_key;
+} PathItem;
+
+// Fields readers load share the first line; anything writers touch on every update
+// lives on its own line so it does not bounce the readers' one.
+typedef struct ConcurrentTrie {
+  const Allocator *allocator;
+  uint32_t key_size;
+  uint64_t (*fn_key)(const void *);
+  ConcurrentTrieNode *root;
+  alignas(CACHE_LINE_SIZE) _Atomic uint64_t epoch;
+  alignas(CACHE_LINE_SIZE) _Atomic uint64_t count;
+  alignas(CACHE_LINE_SIZE) atomic_flag retire_lock;
+  Array /*<RetiredItem>*/ *retired[3];
+  EpochSlot slots[CONCURRENT_TRIE_MAX_THREADS];
+} ConcurrentTrie;
+
+#define RETIRE_THRESHOLD 64
+
+static thread_local uint32_t slot_hint;
+
+void delConcurrentTrieNode(ConcurrentTrieNode *trie_node, const Allocator *allocator);
+
+ConcurrentTrieNode *ConcurrentTrieNode_new(const Allocator *allocator) {
+  ConcurrentTrieNode *node = allocator->calloc(1, sizeof(ConcurrentTrieNode));
+  if (!node) { return nullptr; }
+  node->children = AVLTree_new(allocator, nullptr);
+  return node;
+}
+
+ConcurrentTrie *ConcurrentTrie_new(
+  uint32_t key_size, uint64_t (*fn_key)(const void *), const Allocator *allocator
+) {
+  if (!key_size || !fn_key) { return nullptr; }
+  ConcurrentTrie *tree =
+    Allocator_aligned_alloc(allocator, CACHE_LINE_SIZE, sizeof(ConcurrentTrie));
+  if (!tree) { return nullptr; }
+  allocator->memset(tree, 0, sizeof(ConcurrentTrie));
+  tree->allocator = allocator;
+  tree->key_size = key_size;
+  tree->fn_key = fn_key;
+  tree->root = ConcurrentTrieNode_new(allocator);
+  atomic_flag_clear(&tree->retire_lock);
+  for (uint32_t i = 0; i < 3; i++) {
+    tree->retired[i] = Array_new(sizeof(RetiredItem), -1, allocator);
+  }
+  return tree;
+}
+
+uint64_t ConcurrentTrie_count(const ConcurrentTrie *tree) {
+  return atomic_load_explicit(&tree->count, memory_order_relaxed);
+}
+
+// Yields after each full pass, so threads beyond `CONCURRENT_TRIE_MAX_THREADS` wait
+// for a slot without burning a core.
+static EpochSlot *epoch_enter(ConcurrentTrie *tree) {
+  uint32_t i = slot_hint;
+  for (uint32_t tries = 1;; tries++, i = (i + 1) % CONCURRENT_TRIE_MAX_THREADS) {
+    uint64_t expected = 0;
+    const uint64_t epoch = atomic_load(&tree->epoch);
+    if (atomic_compare_exchange_weak(&tree->slots[i].state, &expected, (epoch << 1) | 1)) {
+      break;
+    }
+    if (tries % CONCURRENT_TRIE_MAX_THREADS == 0) { thrd_yield(); }
+  }
+  slot_hint = i;
+  return &tree->slots[i];
+}
+
+static void epoch_leave(EpochSlot *slot) {
+  atomic_store_explicit(&slot->state, 0, memory_order_release);
+}
+
+static void spin_lock(atomic_flag *lock) {
+  while (atomic_flag_test_and_set_explicit(lock, memory_order_acquire)) { thrd_yield(); }
+}
+
+static void spin_unlock(atomic_flag *lock) {
+  atomic_flag_clear_explicit(lock, memory_order_release);
+}
+
+ConcurrentTrieGuard *ConcurrentTrie_enter(ConcurrentTrie *tree) {
+  return tree ? epoch_enter(tree) : nullptr;
+}
+
+void ConcurrentTrie_leave(ConcurrentTrieGuard *guard) {
+  if (guard) { epoch_leave(guard); }
+}
+
+static void epoch_reclaim(ConcurrentTrie *tree, Array *retired) {
+  const uint32_t count = Array_length(retired);
+  for (uint32_t i = 0; i < count; i++) {
+    const RetiredItem *item = Array_real_addr(retired, i);
+    item->fn_del(item->ptr, tree->allocator);
+  }
+  Array_clear(retired, nullptr);
+}
+
+// Must hold `retire_lock`. Items retired two epochs ago are unreachable once every
+// active thread has entered the current epoch. Returns their list, swapped out for an
+// empty one, so the caller can run the destructors after dropping the lock.
+static Array *epoch_try_advance(ConcurrentTrie *tree) {
+  const uint64_t epoch = atomic_load(&tree->epoch);
+  for (uint32_t i = 0; i < CONCURRENT_TRIE_MAX_THREADS; i++) {
+    const uint64_t state = atomic_load(&tree->slots[i].state);
+    if ((state & 1) && (state >> 1) != epoch) { return nullptr; }
+  }
+  Array *empty = Array_new(sizeof(RetiredItem), -1, tree->allocator);
+  if (!empty) { return nullptr; }
+  atomic_store(&tree->epoch, epoch + 1);
+  Array *reclaimable = tree->retired[(epoch + 2) % 3];
+  tree->retired[(epoch + 2) % 3] = empty;
+  return reclaimable;
+}
+
+// Destructors run outside `retire_lock`, so a `del_content` may itself use the trie.
+static void epoch_retire(ConcurrentTrie *tree, void *ptr, destruct_t *fn_del) {
+  const RetiredItem item = {.ptr = ptr, .fn_del = fn_del};
+  Array *reclaimable = nullptr;
+  spin_lock(&tree->retire_lock);
+  Array *retired = tree->retired[atomic_load(&tree->epoch) % 3];
+  Array_append(retired, &item, 1);
+  if (Array_length(retired) >= RETIRE_THRESHOLD) { reclaimable = epoch_try_advance(tree); }
+  spin_unlock(&tree->retire_lock);
+  if (reclaimable) {
+    epoch_reclaim(tree, reclaimable);
+    releasePrimeArray(reclaimable);
+  }
+}
+
+static void free_avl_node(void *node, const Allocator *allocator) {
+  allocator->free(node);
+}
+
+static void node_lock(ConcurrentTrieNode *node) {
+  for (;;) {
+    uint64_t version = atomic_load_explicit(&node->version, memory_order_relaxed);
+    if (!(version & 1)
+        && atomic_compare_exchange_weak_explicit(
+          &node->version, &version, version + 1, memory_order_acquire, memory_order_relaxed
+        )) {
+      break;
+    }
+    thrd_yield();
+  }
+  atomic_thread_fence(memory_order_release);
+}
+
+static void node_unlock(ConcurrentTrieNode *node) {
+  atomic_fetch_add_explicit(&node->version, 1, memory_order_release);
+}
+
+static uint64_t node_read_begin(const ConcurrentTrieNode *node) {
+  for (;;) {
+    const uint64_t version = atomic_load_explicit(&node->version, memory_order_acquire);
+    if (!(version & 1)) { return version; }
+    thrd_yield();
+  }
+}
+
+static bool node_read_validate(const ConcurrentTrieNode *node, uint64_t version) {
+  atomic_thread_fence(memory_order_acquire);
+  return atomic_load_explicit(&node->version, memory_order_relaxed) == version;
+}
+
+static ConcurrentTrieNode *node_child(const ConcurrentTrieNode *node, uint64_t v_key) {
+  for (;;) {
+    const uint64_t version = node_read_begin(node);
+    ConcurrentTrieNode *child = AVLTree_concurrent_get(node->children, v_key);
+    if (node_read_validate(node, version)) { return child; }
+  }
+}
+
+#define foreach_v_key()                                \
+  for (uint64_t v_key = tree->fn_key(key); v_key != 0; \
+       (key += tree->key_size), (v_key = tree->fn_key(key)))
+
+void *ConcurrentTrie_get(ConcurrentTrie *tree, const void *key) {
+  if (!tree) { return nullptr; }
+  const ConcurrentTrieNode *trie_node = tree->root;
+  foreach_v_key() {
+    trie_node = node_child(trie_node, v_key);
+    if (!trie_node) { return nullptr; }
+  }
+  return atomic_load_explicit(&trie_node->value, memory_order_acquire);
+}
+
+int32_t ConcurrentTrie_set(
+  ConcurrentTrie *tree, const void *key, void *value, destruct_t *del_content
+) {
+  if (!tree) { return -1; }
+  EpochSlot *slot = epoch_enter(tree);
+  const void * const key_begin = key;
+  ConcurrentTrieNode *trie_node;
+__set_restart:
+  key = key_begin;
+  trie_node = tree->root;
+  foreach_v_key() {
+    ConcurrentTrieNode *node = node_child(trie_node, v_key);
+    if (!node) {
+      node_lock(trie_node);
+      if (trie_node->retired) {
+        node_unlock(trie_node);
+        goto __set_restart;
+      }
+      node = AVLTree_get(trie_node->children, v_key);
+      if (!node) {
+        node = ConcurrentTrieNode_new(tree->allocator);
+        if (!node || AVLTree_concurrent_set(trie_node->children, v_key, node)) {
+          node_unlock(trie_node);
+          delConcurrentTrieNode(node, tree->allocator);
+          epoch_leave(slot);
+          return -1;
+        }
+      }
+      node_unlock(trie_node);
+    }
+    trie_node = node;
+  }
+  node_lock(trie_node);
+  if (trie_node->retired) {
+    node_unlock(trie_node);
+    goto __set_restart;
+  }
+  void *old_value = atomic_load_explicit(&trie_node->value, memory_order_relaxed);
+  if (!old_value && value) { atomic_fetch_add(&tree->count, 1); }
+  if (old_value && !value) { atomic_fetch_sub(&tree->count, 1); }
+  atomic_store_explicit(&trie_node->value, value, memory_order_release);
+  node_unlock(trie_node);
+  if (del_content && old_value && old_value != value) {
+    epoch_retire(tree, old_value, del_content);
+  }
+  epoch_leave(slot);
+  return 0;
+}
+
+void ConcurrentTrie_del(ConcurrentTrie *tree, const void *key, destruct_t *del_content) {
+  if (!tree) { return; }
+  EpochSlot *slot = epoch_enter(tree);
+  Array /*<PathItem>*/ *path = Array_new(sizeof(PathItem), -1, tree->allocator);
+  const void * const key_begin = key;
+  ConcurrentTrieNode *trie_node;
+__del_restart:
+  Array_clear(path, nullptr);
+  key = key_begin;
+  trie_node = tree->root;
+  foreach_v_key() {
+    ConcurrentTrieNode *node = node_child(trie_node, v_key);
+    if (!node) { goto __del_exit; }
+    const PathItem item = {.node = trie_node, .v_key = v_key};
+    Array_append(path, &item, 1);
+    trie_node = node;
+  }
+  node_lock(trie_node);
+  if (trie_node->retired) {
+    node_unlock(trie_node);
+    goto __del_restart;
+  }
+  void *value = atomic_load_explicit(&trie_node->value, memory_order_relaxed);
+  if (value) {
+    atomic_store_explicit(&trie_node->value, nullptr, memory_order_release);
+    atomic_fetch_sub(&tree->count, 1);
+  }
+  node_unlock(trie_node);
+  if (!value) { goto __del_exit; }
+  if (del_content) { epoch_retire(tree, value, del_content); }
+
+  // Unlink nodes left without value and children, bottom up. Locks go parent before child.
+  for (uint32_t i = Array_length(path); i > 0; i--) {
+    const PathItem *item = Array_real_addr(path, i - 1);
+    ConcurrentTrieNode *parent = item->node;
+    node_lock(parent);
+    node_lock(trie_node);
+    const bool prunable = !parent->retired && !trie_node->retired && !trie_node->value
+                       && !AVLTree_count(trie_node->children)
+                       && AVLTree_get(parent->children, item->v_key) == trie_node;
+    void *avl_node = nullptr;
+    if (prunable) {
+      avl_node = AVLTree_concurrent_del(parent->children, item->v_key);
+      trie_node->retired = true;
+    }
+    node_unlock(trie_node);
+    node_unlock(parent);
+    if (!prunable) { break; }
+    epoch_retire(tree, avl_node, free_avl_node);
+    epoch_retire(tree, trie_node, (destruct_t *) delConcurrentTrieNode);
+    trie_node = parent;
+  }
+
+__del_exit:
+  releasePrimeArray(path);
+  epoch_leave(slot);
+}
+
+void delConcurrentTrieNode(ConcurrentTrieNode *trie_node, const Allocator *allocator) {
+  if (!trie_node) { return; }
+  AVLTree_destroy(trie_node->children, (destruct_t *) delConcurrentTrieNode);
+  allocator->free(trie_node);
+}
+
+void ConcurrentTrie_destroy(ConcurrentTrie *tree) {
+  if (!tree) { return; }
+  delConcurrentTrieNode(tree->root, tree->allocator);
+  for (uint32_t i = 0; i < 3; i++) {
+    epoch_reclaim(tree, tree->retired[i]);
+    releasePrimeArray(tree->retired[i]);
+  }
+  Allocator_aligned_free(tree->allocator, tree);
+}
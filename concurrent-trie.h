@@ -0,0 +1,40 @@
+/**
+ * Filename: concurrent-trie.h
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-18
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#ifndef LIU_CONCURRENT_TRIE_H
+#define LIU_CONCURRENT_TRIE_H
+
+#include "allocator.h"
+#include <stdint.h>
+
+// Number of threads that may be inside a `ConcurrentTrie` operation at the same time.
+#define CONCURRENT_TRIE_MAX_THREADS 128
+
+typedef struct ConcurrentTrie ConcurrentTrie;
+typedef struct ConcurrentTrieGuard ConcurrentTrieGuard;
+
+// Same key convention as `Trie`: units of `key_size` bytes read by `fn_key`, ended by 0.
+ConcurrentTrie *
+  ConcurrentTrie_new(uint32_t key_size, uint64_t (*fn_key)(const void *), const Allocator *allocator);
+// Not thread-safe: no other operation may run on `tree` during destroy.
+void ConcurrentTrie_destroy(ConcurrentTrie *tree);
+
+uint64_t ConcurrentTrie_count(const ConcurrentTrie *tree);
+// Read-side critical section: nodes and values seen between enter and leave are not
+// freed until the guard is left.
+ConcurrentTrieGuard *ConcurrentTrie_enter(ConcurrentTrie *tree);
+void ConcurrentTrie_leave(ConcurrentTrieGuard *guard);
+// Must be called inside a guard, and the returned value used only until it is left.
+// Readers take no lock; they validate node versions and retry on conflict.
+void *ConcurrentTrie_get(ConcurrentTrie *tree, const void *key);
+// `del_content` receives a replaced or deleted value once every guard that could have
+// returned it from `ConcurrentTrie_get` has been left.
+int32_t
+  ConcurrentTrie_set(ConcurrentTrie *tree, const void *key, void *value, destruct_t *del_content);
+void ConcurrentTrie_del(ConcurrentTrie *tree, const void *key, destruct_t *del_content);
+
+#endif  // LIU_CONCURRENT_TRIE_H
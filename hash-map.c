@@ -0,0 +1,319 @@
+/**
+ * Filename: hash-map.c
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-18
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#include "hash-map.h"
+#include "array.h"
+#include "traversal.h"
+
+#ifdef __SSE2__
+  #include <emmintrin.h>
+#endif
+
+// Control bytes: `CTRL_EMPTY`, or the low 7 bits of the hash of a full slot.
+// Probing is linear, one group of control bytes at a time, and deletion shifts
+// later entries back, so there are no tombstones.
+#define GROUP_SIZE      16
+#define CTRL_EMPTY      0x80
+#define MIN_CAPACITY    GROUP_SIZE
+#define MIGRATE_STEP    (2 * GROUP_SIZE)
+#define NOT_FOUND       UINT64_MAX
+
+typedef struct {
+  uint64_t key;
+  void *value;
+} HashSlot;
+
+typedef struct {
+  // `capacity + GROUP_SIZE - 1` bytes; the tail mirrors the head so a group may wrap.
+  uint8_t *ctrl;
+  HashSlot *slots;
+  uint64_t capacity;
+  uint64_t count;
+} HashTable;
+
+typedef struct HashMap {
+  const Allocator *allocator;
+  hash_t *fn_hash;
+  equal_t *fn_equal;
+  HashTable table;
+  // While growing, entries move from `old` to `table` a few slots per update,
+  // scanning from just after the empty slot `migrate_begin`.
+  HashTable old;
+  uint64_t migrate_begin;
+  uint64_t migrated;
+} HashMap;
+
+#ifdef __SSE2__
+static inline uint32_t group_match(const uint8_t *ctrl, uint8_t h2) {
+  const __m128i group = _mm_loadu_si128((const __m128i *) ctrl);
+  return (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char) h2)));
+}
+
+static inline uint32_t group_empty(const uint8_t *ctrl) {
+  return (uint32_t) _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) ctrl));
+}
+#else
+static inline uint32_t group_match(const uint8_t *ctrl, uint8_t h2) {
+  uint32_t mask = 0;
+  for (uint32_t i = 0; i < GROUP_SIZE; i++) { mask |= (uint32_t) (ctrl[i] == h2) << i; }
+  return mask;
+}
+
+static inline uint32_t group_empty(const uint8_t *ctrl) {
+  uint32_t mask = 0;
+  for (uint32_t i = 0; i < GROUP_SIZE; i++) { mask |= (uint32_t) (ctrl[i] >> 7) << i; }
+  return mask;
+}
+#endif
+
+static inline uint64_t HashMap_hash(const HashMap *map, uint64_t key) {
+  if (map->fn_hash) { return map->fn_hash((void *) key); }
+  key ^= key >> 33;
+  key *= 0xFF51'AFD7'ED55'8CCD;
+  key ^= key >> 33;
+  key *= 0xC4CE'B9FE'1A85'EC53;
+  key ^= key >> 33;
+  return key;
+}
+
+static inline bool HashMap_equal(const HashMap *map, uint64_t a, uint64_t b) {
+  return map->fn_equal ? map->fn_equal((void *) a, (void *) b) : a == b;
+}
+
+static inline uint64_t HashTable_home(const HashTable *table, uint64_t hash) {
+  return (hash >> 7) & (table->capacity - 1);
+}
+
+static inline void HashTable_set_ctrl(HashTable *table, uint64_t index, uint8_t ctrl) {
+  table->ctrl[index] = ctrl;
+  if (index < GROUP_SIZE - 1) { table->ctrl[table->capacity + index] = ctrl; }
+}
+
+static int32_t HashTable_init(HashTable *table, uint64_t capacity, const Allocator *allocator) {
+  uint8_t *ctrl = allocator->malloc(capacity + GROUP_SIZE - 1);
+  HashSlot *slots = allocator->malloc(capacity * sizeof(HashSlot));
+  if (!ctrl || !slots) {
+    if (ctrl) { allocator->free(ctrl); }
+    if (slots) { allocator->free(slots); }
+    return -1;
+  }
+  allocator->memset(ctrl, CTRL_EMPTY, capacity + GROUP_SIZE - 1);
+  *table = (HashTable) {.ctrl = ctrl, .slots = slots, .capacity = capacity, .count = 0};
+  return 0;
+}
+
+static void HashTable_release(HashTable *table, destruct_t *del_value, const Allocator *allocator) {
+  if (!table->capacity) { return; }
+  if (del_value) {
+    for (uint64_t i = 0; i < table->capacity; i++) {
+      if (!(table->ctrl[i] & CTRL_EMPTY)) { del_value(table->slots[i].value, allocator); }
+    }
+  }
+  allocator->free(table->ctrl);
+  allocator->free(table->slots);
+  *table = (HashTable) {};
+}
+
+static uint64_t HashTable_find(
+  const HashMap *map, const HashTable *table, uint64_t key, uint64_t hash, uint64_t start
+) {
+  const uint64_t mask = table->capacity - 1;
+  for (uint64_t pos = start;; pos = (pos + GROUP_SIZE) & mask) {
+    for (uint32_t match = group_match(table->ctrl + pos, hash & 0x7F); match; match &= match - 1) {
+      const uint64_t index = (pos + __builtin_ctz(match)) & mask;
+      if (HashMap_equal(map, table->slots[index].key, key)) { return index; }
+    }
+    if (group_empty(table->ctrl + pos)) { return NOT_FOUND; }
+  }
+}
+
+// Caller guarantees `key` is absent and the table has room.
+static void HashTable_insert(HashTable *table, uint64_t key, uint64_t hash, void *value) {
+  const uint64_t mask = table->capacity - 1;
+  for (uint64_t pos = HashTable_home(table, hash);; pos = (pos + GROUP_SIZE) & mask) {
+    const uint32_t empty = group_empty(table->ctrl + pos);
+    if (!empty) { continue; }
+    const uint64_t index = (pos + __builtin_ctz(empty)) & mask;
+    HashTable_set_ctrl(table, index, hash & 0x7F);
+    table->slots[index] = (HashSlot) {.key = key, .value = value};
+    table->count++;
+    return;
+  }
+}
+
+static void HashTable_erase(const HashMap *map, HashTable *table, uint64_t hole) {
+  const uint64_t mask = table->capacity - 1;
+  for (uint64_t i = (hole + 1) & mask; !(table->ctrl[i] & CTRL_EMPTY); i = (i + 1) & mask) {
+    const uint64_t home = HashTable_home(table, HashMap_hash(map, table->slots[i].key));
+    // `i` may fill the hole unless its home lies cyclically in (hole, i].
+    if (((i - home) & mask) >= ((i - hole) & mask)) {
+      HashTable_set_ctrl(table, hole, table->ctrl[i]);
+      table->slots[hole] = table->slots[i];
+      hole = i;
+    }
+  }
+  HashTable_set_ctrl(table, hole, CTRL_EMPTY);
+  table->count--;
+}
+
+static inline bool HashMap_rehashing(const HashMap *map) {
+  return map->old.capacity != 0;
+}
+
+// Slots of `old` already scanned are empty, so a probe whose home was scanned starts
+// at the scan cursor; the rest of its cluster has not been touched yet.
+static uint64_t HashMap_find_old(const HashMap *map, uint64_t key, uint64_t hash) {
+  const HashTable *old = &map->old;
+  const uint64_t mask = old->capacity - 1;
+  uint64_t start = HashTable_home(old, hash);
+  if (((start - map->migrate_begin - 1) & mask) < map->migrated) {
+    start = (map->migrate_begin + 1 + map->migrated) & mask;
+  }
+  return HashTable_find(map, old, key, hash, start);
+}
+
+static void HashMap_move_old(HashMap *map, uint64_t index) {
+  const HashSlot slot = map->old.slots[index];
+  HashTable_insert(&map->table, slot.key, HashMap_hash(map, slot.key), slot.value);
+  HashTable_set_ctrl(&map->old, index, CTRL_EMPTY);
+  map->old.count--;
+}
+
+static void HashMap_migrate(HashMap *map, uint64_t step) {
+  if (!HashMap_rehashing(map)) { return; }
+  const uint64_t mask = map->old.capacity - 1;
+  for (; step && map->old.count; step--, map->migrated++) {
+    const uint64_t index = (map->migrate_begin + 1 + map->migrated) & mask;
+    if (!(map->old.ctrl[index] & CTRL_EMPTY)) { HashMap_move_old(map, index); }
+  }
+  if (!map->old.count) { HashTable_release(&map->old, nullptr, map->allocator); }
+}
+
+// Removing from `old` must not shift entries into the scanned range, so the rest
+// of the cluster moves to `table` instead.
+static void HashMap_erase_old(HashMap *map, uint64_t index) {
+  const uint64_t mask = map->old.capacity - 1;
+  HashTable_set_ctrl(&map->old, index, CTRL_EMPTY);
+  map->old.count--;
+  for (uint64_t i = (index + 1) & mask; !(map->old.ctrl[i] & CTRL_EMPTY); i = (i + 1) & mask) {
+    HashMap_move_old(map, i);
+  }
+  if (!map->old.count) { HashTable_release(&map->old, nullptr, map->allocator); }
+}
+
+static int32_t HashMap_grow(HashMap *map) {
+  if (HashMap_rehashing(map)) { HashMap_migrate(map, map->old.capacity); }
+  const uint64_t capacity = map->table.capacity ? map->table.capacity * 2 : MIN_CAPACITY;
+  HashTable table;
+  if (HashTable_init(&table, capacity, map->allocator)) { return -1; }
+  map->old = map->table;
+  map->table = table;
+  map->migrated = 0;
+  if (!map->old.count) {
+    HashTable_release(&map->old, nullptr, map->allocator);
+    return 0;
+  }
+  for (uint64_t i = 0; i < map->old.capacity; i++) {
+    if (map->old.ctrl[i] & CTRL_EMPTY) {
+      map->migrate_begin = i;
+      break;
+    }
+  }
+  return 0;
+}
+
+HashMap *HashMap_new(const Allocator *allocator, hash_t *fn_hash, equal_t *fn_equal) {
+  if (!fn_hash != !fn_equal) { return nullptr; }
+  HashMap *map = allocator->calloc(1, sizeof(HashMap));
+  if (!map) { return nullptr; }
+  map->allocator = allocator;
+  map->fn_hash = fn_hash;
+  map->fn_equal = fn_equal;
+  return map;
+}
+
+uint64_t HashMap_count(const HashMap *map) {
+  return map->table.count + map->old.count;
+}
+
+void *HashMap_get(const HashMap *map, uint64_t key) {
+  if (!map) { return nullptr; }
+  const uint64_t hash = HashMap_hash(map, key);
+  if (HashMap_rehashing(map)) {
+    const uint64_t index = HashMap_find_old(map, key, hash);
+    if (index != NOT_FOUND) { return map->old.slots[index].value; }
+  }
+  if (!map->table.count) { return nullptr; }
+  const uint64_t index =
+    HashTable_find(map, &map->table, key, hash, HashTable_home(&map->table, hash));
+  return index != NOT_FOUND ? map->table.slots[index].value : nullptr;
+}
+
+int32_t HashMap_set(HashMap *map, uint64_t key, void *value) {
+  if (!map) { return -1; }
+  const uint64_t hash = HashMap_hash(map, key);
+  uint64_t index = NOT_FOUND;
+  if (HashMap_rehashing(map) && (index = HashMap_find_old(map, key, hash)) != NOT_FOUND) {
+    map->old.slots[index].value = value;
+  } else if (map->table.count
+             && (index = HashTable_find(
+                   map, &map->table, key, hash, HashTable_home(&map->table, hash)
+                 )) != NOT_FOUND) {
+    map->table.slots[index].value = value;
+  } else {
+    const uint64_t capacity = map->table.capacity;
+    if (map->table.count + 1 > capacity - capacity / 8 && HashMap_grow(map)) { return -1; }
+    HashTable_insert(&map->table, key, hash, value);
+  }
+  HashMap_migrate(map, MIGRATE_STEP);
+  return 0;
+}
+
+int32_t HashMap_del(HashMap *map, uint64_t key, destruct_t *del_value) {
+  if (!map) { return -1; }
+  const uint64_t hash = HashMap_hash(map, key);
+  void *value;
+  uint64_t index = NOT_FOUND;
+  if (HashMap_rehashing(map) && (index = HashMap_find_old(map, key, hash)) != NOT_FOUND) {
+    value = map->old.slots[index].value;
+    HashMap_erase_old(map, index);
+  } else if (map->table.count
+             && (index = HashTable_find(
+                   map, &map->table, key, hash, HashTable_home(&map->table, hash)
+                 )) != NOT_FOUND) {
+    value = map->table.slots[index].value;
+    HashTable_erase(map, &map->table, index);
+  } else {
+    return -1;
+  }
+  if (del_value) { del_value(value, map->allocator); }
+  HashMap_migrate(map, MIGRATE_STEP);
+  return 0;
+}
+
+static void HashTable_traversal(const HashTable *table, Array *pair_array) {
+  for (uint64_t i = 0; i < table->capacity; i++) {
+    if (table->ctrl[i] & CTRL_EMPTY) { continue; }
+    AVLPair pair = {.key = table->slots[i].key, .value = table->slots[i].value};
+    Array_append(pair_array, &pair, 1);
+  }
+}
+
+Array /*<AVLPair>*/ *HashMap_traversal(const HashMap *map, uint32_t id, const Allocator *allocator) {
+  if (!map) { return nullptr; }
+  Array *pair_array = Array_new(sizeof(AVLPair), id, allocator);
+  HashTable_traversal(&map->old, pair_array);
+  HashTable_traversal(&map->table, pair_array);
+  return pair_array;
+}
+
+void HashMap_destroy(HashMap *map, destruct_t *del_value) {
+  if (!map) { return; }
+  HashTable_release(&map->old, del_value, map->allocator);
+  HashTable_release(&map->table, del_value, map->allocator);
+  map->allocator->free(map);
+}
@@ -0,0 +1,31 @@
+/**
+ * Filename: hash-map.h
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-18
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#ifndef LIU_HASH_MAP_H
+#define LIU_HASH_MAP_H
+
+#include "allocator.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct HashMap HashMap;
+
+typedef uint64_t hash_t(void *);
+typedef bool equal_t(void *, void *);
+
+// Without `fn_hash` and `fn_equal` keys are plain `uint64_t`; otherwise a key is
+// passed to them as a pointer, e.g. to a byte string owned by the caller.
+HashMap *HashMap_new(const Allocator *allocator, hash_t *fn_hash, equal_t *fn_equal);
+void HashMap_destroy(HashMap *map, destruct_t *del_value);
+
+uint64_t HashMap_count(const HashMap *map);
+void *HashMap_get(const HashMap *map, uint64_t key);
+int32_t HashMap_set(HashMap *map, uint64_t key, void *value);
+// Return 0 if `key` was removed, -1 if it was not present.
+int32_t HashMap_del(HashMap *map, uint64_t key, destruct_t *del_value);
+
+#endif  // LIU_HASH_MAP_H
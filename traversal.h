@@ -12,6 +12,7 @@
 
 #include "array.h"
 #include "avl-tree.h"
+#include "hash-map.h"
 
 typedef struct AVLPair {
   uint64_t key;
@@ -23,4 +24,7 @@ typedef void traverse_t(const AVLPair *, ...);
 Array /*<AVLPair>*/ *
   AVLTree_inorder_traversal(AVLTree *tree, uint32_t id, const Allocator *allocator);
 
+// Pairs come in slot order, not key order.
+Array /*<AVLPair>*/ *HashMap_traversal(const HashMap *map, uint32_t id, const Allocator *allocator);
+
 #endif  // MACHINE_TRAVERSAL_H
@@ -0,0 +1,95 @@
+/**
+ * Filename: trie-spec.c
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-18
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#include "trie-spec.h"
+#include "avl-tree.h"
+
+typedef struct TrieSpecNode TrieSpecNode;
+
+typedef struct TrieSpecNode {
+  void *value;
+  AVLTree *children;
+} TrieSpecNode;
+
+TrieSpecNode *TrieSpecNode_new(const Allocator *allocator) {
+  TrieSpecNode *node = allocator->calloc(1, sizeof(TrieSpecNode));
+  node->children = AVLTree_new(allocator, nullptr);
+  return node;
+}
+
+void delTrieSpecNode(TrieSpecNode *trie_node, const Allocator *allocator) {
+  if (!trie_node) { return; }
+  AVLTree_destroy(trie_node->children, (destruct_t *) delTrieSpecNode);
+  allocator->free(trie_node);
+}
+
+#define TRIE_SPEC_DEFINE(_name, _unit_t)                                                     \
+  typedef struct _name {                                                                     \
+    const Allocator *allocator;                                                              \
+    uint64_t count;                                                                          \
+    TrieSpecNode *root;                                                                      \
+  } _name;                                                                                   \
+                                                                                             \
+  _name *_name##_new(const Allocator *allocator) {                                           \
+    _name *tree = allocator->calloc(1, sizeof(_name));                                       \
+    tree->allocator = allocator;                                                             \
+    tree->root = TrieSpecNode_new(allocator);                                                \
+    return tree;                                                                             \
+  }                                                                                          \
+                                                                                             \
+  uint64_t _name##_count(const _name *tree) {                                                \
+    return tree->count;                                                                      \
+  }                                                                                          \
+                                                                                             \
+  void *_name##_get(const _name *tree, const _unit_t *key, uint32_t len) {                   \
+    if (!tree) { return nullptr; }                                                           \
+    const TrieSpecNode *trie_node = tree->root;                                              \
+    for (uint32_t i = 0; i < len; i++) {                                                     \
+      trie_node = AVLTree_get(trie_node->children, key[i]);                                  \
+      if (!trie_node) { return nullptr; }                                                    \
+    }                                                                                        \
+    return trie_node->value;                                                                 \
+  }                                                                                          \
+                                                                                             \
+  void _name##_set(_name *tree, const _unit_t *key, uint32_t len, void *value) {             \
+    if (!tree) { return; }                                                                   \
+    TrieSpecNode *trie_node = tree->root;                                                    \
+    for (uint32_t i = 0; i < len; i++) {                                                     \
+      auto node = (TrieSpecNode *) AVLTree_get(trie_node->children, key[i]);                 \
+      if (!node) {                                                                           \
+        node = TrieSpecNode_new(tree->allocator);                                            \
+        AVLTree_set(trie_node->children, key[i], node);                                      \
+      }                                                                                      \
+      trie_node = node;                                                                      \
+    }                                                                                        \
+    if (!trie_node->value) { tree->count++; }                                                \
+    trie_node->value = value;                                                                \
+  }                                                                                          \
+                                                                                             \
+  void _name##_del(_name *tree, const _unit_t *key, uint32_t len, destruct_t *del_content) { \
+    if (!tree) { return; }                                                                   \
+    TrieSpecNode *trie_node = tree->root;                                                    \
+    for (uint32_t i = 0; i < len; i++) {                                                     \
+      trie_node = AVLTree_get(trie_node->children, key[i]);                                  \
+      if (!trie_node) { return; }                                                            \
+    }                                                                                        \
+    if (!trie_node->value) { return; }                                                       \
+    if (del_content) { del_content(trie_node->value, tree->allocator); }                     \
+    trie_node->value = nullptr;                                                              \
+    tree->count--;                                                                           \
+  }                                                                                          \
+                                                                                             \
+  void _name##_destroy(_name *tree) {                                                        \
+    if (!tree) { return; }                                                                   \
+    delTrieSpecNode(tree->root, tree->allocator);                                            \
+    tree->allocator->free(tree);                                                             \
+  }
+
+TRIE_SPEC_DEFINE(Trie8, uint8_t)
+TRIE_SPEC_DEFINE(Trie16, uint16_t)
+TRIE_SPEC_DEFINE(Trie32, uint32_t)
+TRIE_SPEC_DEFINE(Trie64, uint64_t)
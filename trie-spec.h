@@ -0,0 +1,30 @@
+/**
+ * Filename: trie-spec.h
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-18
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#ifndef LIU_TRIE_SPEC_H
+#define LIU_TRIE_SPEC_H
+
+#include "allocator.h"
+#include <stdint.h>
+
+// Tries specialized for one key unit type. Keys are `(key, len)` unit arrays,
+// so a unit may be 0, and units are read directly instead of through `fn_key`.
+#define TRIE_SPEC_DECLARE(_name, _unit_t)                                                     \
+  typedef struct _name _name;                                                                 \
+  _name *_name##_new(const Allocator *allocator);                                             \
+  void _name##_destroy(_name *tree);                                                          \
+  uint64_t _name##_count(const _name *tree);                                                  \
+  void *_name##_get(const _name *tree, const _unit_t *key, uint32_t len);                     \
+  void _name##_set(_name *tree, const _unit_t *key, uint32_t len, void *value);               \
+  void _name##_del(_name *tree, const _unit_t *key, uint32_t len, destruct_t *del_content)
+
+TRIE_SPEC_DECLARE(Trie8, uint8_t);
+TRIE_SPEC_DECLARE(Trie16, uint16_t);
+TRIE_SPEC_DECLARE(Trie32, uint32_t);
+TRIE_SPEC_DECLARE(Trie64, uint64_t);
+
+#endif  // LIU_TRIE_SPEC_H
@@ -0,0 +1,49 @@
+/**
+ * Project Name: machine
+ * Module Name: meman
+ * Filename: trie-stats.h
+ * Creator: Yaokai Liu
+ * Create Date: 2026-10-18
+ * Copyright (c) 2026 Yaokai Liu. All rights reserved.
+ **/
+
+#ifndef MACHINE_TRIE_STATS_H
+#define MACHINE_TRIE_STATS_H
+
+#include "trie.h"
+
+#define TRIE_STATS_FANOUT_BUCKETS 16
+
+typedef struct {
+  uint64_t node_count;
+  uint64_t value_count;
+  uint64_t max_depth;
+  // Mean depth of nodes holding a value, i.e. mean key length in units.
+  double avg_depth;
+  // `fanout[0]` counts leaves, `fanout[i]` nodes with [2^(i-1), 2^i) children.
+  // The last bucket also takes every larger fanout.
+  uint64_t fanout[TRIE_STATS_FANOUT_BUCKETS];
+  // Non-root nodes without a value.
+  uint64_t valueless_nodes;
+  // Valueless leaves, e.g. those left behind by `Trie_del`.
+  uint64_t dead_leaves;
+  uint64_t node_bytes;
+  uint64_t avl_bytes;
+} TrieStats;
+
+void Trie_stats(const Trie *trie, TrieStats *stats);
+
+#ifdef TRIE_COUNTERS
+typedef struct {
+  uint64_t get_calls;
+  uint64_t set_calls;
+  uint64_t del_calls;
+  uint64_t nodes_visited;
+  uint64_t avl_compares;
+} TrieCounters;
+
+void Trie_counters(const Trie *trie, TrieCounters *counters);
+void Trie_reset_counters(Trie *trie);
+#endif
+
+#endif  // MACHINE_TRIE_STATS_H
@@ -10,6 +10,7 @@
 #include "avl-tree.h"
 #include "traversal.h"
 #include "trie-dump.h"
+#include "trie-stats.h"
 
 typedef struct TrieNode TrieNode;
 
@@ -24,9 +25,20 @@ typedef struct Trie {
   uint64_t (*fn_key)(const void *);
   uint64_t count;
   TrieNode *root;
+#ifdef TRIE_COUNTERS
+  TrieCounters counters;
+#endif
 } Trie;
 
 void delTrieNode(TrieNode *trie_node, const Allocator *allocator);
+TrieNode *TrieNode_child(const Trie *tree, const TrieNode *trie_node, uint64_t v_key);
+void TrieNode_add_child(Trie *tree, TrieNode *trie_node, uint64_t v_key, TrieNode *child);
+
+#ifdef TRIE_COUNTERS
+  #define count_call(_field) (((Trie *) tree)->counters._field++)
+#else
+  #define count_call(_field) ((void) 0)
+#endif
 
 Trie *Trie_new(uint32_t key_size, uint64_t (*fn_key)(const void *), const Allocator *allocator) {
   if (!key_size || !fn_key) { return nullptr; }
@@ -48,12 +60,38 @@ uint64_t Trie_count(const Trie *tree) {
   for (uint64_t v_key = tree->fn_key(key); v_key != 0; \
        (key += tree->key_size), (v_key = tree->fn_key(key)))
 
+inline TrieNode *TrieNode_child(const Trie *tree, const TrieNode *trie_node, uint64_t v_key) {
+#ifdef TRIE_COUNTERS
+  const uint64_t compares = AVLTree_compares(trie_node->children);
+  TrieNode *child = AVLTree_get(trie_node->children, v_key);
+  ((Trie *) tree)->counters.avl_compares += AVLTree_compares(trie_node->children) - compares;
+  ((Trie *) tree)->counters.nodes_visited++;
+  return child;
+#else
+  (void) tree;
+  return AVLTree_get(trie_node->children, v_key);
+#endif
+}
+
+// Inserting walks the child tree again, so its comparisons are counted too.
+inline void TrieNode_add_child(Trie *tree, TrieNode *trie_node, uint64_t v_key, TrieNode *child) {
+#ifdef TRIE_COUNTERS
+  const uint64_t compares = AVLTree_compares(trie_node->children);
+  AVLTree_set(trie_node->children, v_key, child);
+  tree->counters.avl_compares += AVLTree_compares(trie_node->children) - compares;
+#else
+  (void) tree;
+  AVLTree_set(trie_node->children, v_key, child);
+#endif
+}
+
 void *Trie_get(const Trie *tree, const void *key) {
   if (!tree) { return nullptr; }
+  count_call(get_calls);
   const TrieNode *trie_node = tree->root;
   foreach_v_key() {
     if (!trie_node->children) { return nullptr; }
-    trie_node = AVLTree_get(trie_node->children, v_key);
+    trie_node = TrieNode_child(tree, trie_node, v_key);
     if (!trie_node) { return nullptr; };
   }
   return trie_node->value;
@@ -61,13 +99,14 @@ void *Trie_get(const Trie *tree, const void *key) {
 
 void Trie_set(Trie *tree, const void *key, void *value) {
   if (!tree) { return; }
+  count_call(set_calls);
   TrieNode *trie_node = tree->root;
   foreach_v_key() {
-    auto node = (TrieNode *) AVLTree_get(trie_node->children, v_key);
+    auto node = TrieNode_child(tree, trie_node, v_key);
     if (!node) {
       node = tree->allocator->calloc(1, sizeof(TrieNode));
       node->children = AVLTree_new(tree->allocator, nullptr);
-      AVLTree_set(trie_node->children, v_key, node);
+      TrieNode_add_child(tree, trie_node, v_key, node);
     }
     trie_node = node;
   }
@@ -116,15 +155,64 @@ void Trie_dump(
   TrieNode_dump(trie->root, key_array, node_array, trie->allocator);
 }
 
+void TrieNode_stats(
+  const TrieNode *node, uint64_t depth, TrieStats *stats, const Allocator *allocator
+);
+void TrieNode_stats(
+  const TrieNode *node, uint64_t depth, TrieStats *stats, const Allocator *allocator
+) {
+  const uint64_t fanout = AVLTree_count(node->children);
+  stats->node_count++;
+  stats->node_bytes += sizeof(TrieNode);
+  if (node->children) { stats->avl_bytes += sizeof_avl_tree + fanout * sizeof_avl_node; }
+  if (depth > stats->max_depth) { stats->max_depth = depth; }
+  if (node->value) {
+    stats->value_count++;
+    stats->avg_depth += (double) depth;
+  } else if (depth > 0) {
+    stats->valueless_nodes++;
+    if (fanout == 0) { stats->dead_leaves++; }
+  }
+  uint32_t bucket = 0;
+  while (bucket < TRIE_STATS_FANOUT_BUCKETS - 1 && fanout >> bucket) { bucket++; }
+  stats->fanout[bucket]++;
+  if (fanout == 0) { return; }
+
+  Array *child_array = AVLTree_inorder_traversal(node->children, -1, allocator);
+  const AVLPair * const children = Array_real_addr(child_array, 0);
+  for (uint32_t i = 0; i < Array_length(child_array); i++) {
+    TrieNode_stats(children[i].value, depth + 1, stats, allocator);
+  }
+  releasePrimeArray(child_array);
+}
+
+void Trie_stats(const Trie *trie, TrieStats *stats) {
+  if (!trie || !stats) { return; }
+  *stats = (TrieStats) {};
+  TrieNode_stats(trie->root, 0, stats, trie->allocator);
+  if (stats->value_count) { stats->avg_depth /= (double) stats->value_count; }
+}
+
+#ifdef TRIE_COUNTERS
+void Trie_counters(const Trie *trie, TrieCounters *counters) {
+  if (!trie || !counters) { return; }
+  *counters = trie->counters;
+}
+
+void Trie_reset_counters(Trie *trie) {
+  if (!trie) { return; }
+  trie->counters = (TrieCounters) {};
+}
+#endif
+
 void Trie_del(Trie *tree, const void *key, destruct_t *del_content) {
+  count_call(del_calls);
   TrieNode *trie_node = tree->root;
   if (!trie_node->children) { return; }
-  uint64_t v_key = tree->fn_key(key);
-  for (; v_key != 0; key += tree->key_size) {
-    TrieNode *node = AVLTree_get(trie_node->children, v_key);
+  foreach_v_key() {
+    TrieNode *node = TrieNode_child(tree, trie_node, v_key);
     if (!node) { return; }
     trie_node = node;
-    v_key = tree->fn_key(key);
   }
   if (!trie_node->value) { return; }
   if (del_content) { del_content(trie_node->value, tree->allocator); }